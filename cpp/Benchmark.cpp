@@ -0,0 +1,375 @@
+// micro benchmark runner for hot paths of the other samples (Sort, Philosophers, Move, Variadic, Comparison, Lambda)
+// code of the samples is shared through their headers so the benchmarks measure what the samples run (Sort.cpp only calls std::sort, so there is nothing to share),
+// QUIET_SAMPLES leaves out tracing output of the samples from measured code; build as C++20 (Lambda.h uses std::span)
+//
+// usage: Benchmark [--filter name] [--cpu n] [--warmup n] [--repetitions n] [--min-time ms] [--save file.json] [--baseline file.json] [--threshold percent]
+// typical flow is to --save a baseline with known good compiler / flags and then run with --baseline after changing them,
+// exit code is 1 when median of any benchmark got slower than baseline median by more than threshold and even its fastest repetition is slower than baseline median
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <utility>
+#include <cstring>
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <sched.h>
+#elif defined(_WIN32)
+#define NOMINMAX // otherwise min and max macros break std::min and std::max
+#include <windows.h>
+#endif
+
+#define QUIET_SAMPLES
+#include "Lambda.h"
+#include "Comparison.h"
+#include "Philosophers.h"
+#include "Move.h"
+#include "Variadic.h"
+
+// keeps the compiler from proving value is unused and removing computation of it
+template <class T>
+void doNotOptimize(T const& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static const void* volatile sink;
+	sink = &value;
+#endif
+}
+
+// same as above, in addition compiler has to assume value has been changed so it can not be constant folded
+template <class T>
+void doNotOptimize(T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : "+m"(value) : : "memory");
+#else
+	static void* volatile sink;
+	sink = &value;
+#endif
+}
+
+bool pinToCpu(int cpu)
+{
+#if defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return sched_setaffinity(0, sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+	return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#else
+	return false;
+#endif
+}
+
+
+// each benchmark has setup done once and body which is timed, body runs iterations times per repetition
+// registered iterations are only a starting point, run() increases them until a repetition takes at least --min-time
+struct Benchmark
+{
+	std::string name;
+	unsigned iterations;
+	std::function<std::function<void()>()> setup; // returns the body, so state prepared by setup lives in the body's captures
+};
+
+std::vector<Benchmark>& registry()
+{
+	static std::vector<Benchmark> benchmarks;
+	return benchmarks;
+}
+
+struct Registrar
+{
+	Registrar(std::string name, unsigned iterations, std::function<std::function<void()>()> setup)
+	{
+		registry().push_back({ std::move(name), iterations, std::move(setup) });
+	}
+};
+
+
+// Sort.cpp: sorting shuffled unsigned longs
+Registrar sortBenchmark("Sort", 1, []() {
+	std::vector<unsigned long> v(1000000);
+	std::iota(v.begin(), v.end(), 0);
+	std::shuffle(v.begin(), v.end(), std::mt19937{ 42 });
+	return [v]() {
+		std::vector<unsigned long> copy = v;
+		std::sort(copy.begin(), copy.end());
+		doNotOptimize(copy.data());
+	};
+});
+
+// Philosophers.cpp: taking and leaving two forks with MultiLock
+Registrar philosophersBenchmark("Philosophers", 100000, []() {
+	auto forks = std::make_shared<std::array<QuietFork, 2>>();
+	return [forks]() {
+		QuietFork* pair[] = { &(*forks)[1], &(*forks)[0] };
+		MultiLock<QuietFork> lockForks(pair, 2);
+		doNotOptimize(pair);
+	};
+});
+
+// Move.cpp: pushing and inserting MemoryMoveBlock into vector, i.e. move construction and assignment
+Registrar moveBenchmark("Move", 1000, []() {
+	return []() {
+		std::vector<MemoryMoveBlock> v;
+		v.reserve(4);
+		v.push_back(MemoryMoveBlock());
+		v.push_back(MemoryMoveBlock());
+		v.insert(++v.begin(), MemoryMoveBlock());
+		doNotOptimize(v.data());
+	};
+});
+
+// Variadic.cpp: constructing recursive tuple and getting its members
+Registrar variadicBenchmark("Variadic", 1000000, []() {
+	return []() {
+		double d = 12.2;
+		doNotOptimize(d);
+		tuple<double, uint64_t, const char*> t1(d, 42, "big");
+		get<1>(t1) = 103;
+		double sum = get<0>(t1) + get<1>(t1);
+		const char* s = get<2>(t1);
+		doNotOptimize(sum);
+		doNotOptimize(s);
+	};
+});
+
+// Comparison.cpp: heterogeneous comparison of two wrapper types, one pair at a time through the operators and in batch
+std::pair<std::vector<WrapperOne>, std::vector<WrapperTwo>> makeWrappers()
+{
+	std::mt19937 mersenne_engine{ 42 };
+	std::uniform_int_distribution<int> dist(-100, 100);
+	std::vector<WrapperOne> a(1000000);
+	std::vector<WrapperTwo> b(a.size());
+	for (std::size_t i = 0; i < a.size(); i++) {
+		a[i].x = dist(mersenne_engine);
+		b[i].y = dist(mersenne_engine);
+	}
+	return { a, b };
+}
+
+Registrar comparisonBenchmark("Comparison", 1, []() {
+	auto [a, b] = makeWrappers();
+	return [a = std::move(a), b = std::move(b)]() {
+		std::size_t greater = 0;
+		for (std::size_t i = 0; i < a.size(); i++)
+			greater += a[i] > b[i];
+		doNotOptimize(greater);
+	};
+});
+
+Registrar comparisonBatchBenchmark("ComparisonBatch", 1, []() {
+	auto [a, b] = makeWrappers();
+	std::vector<std::uint64_t> mask((a.size() + 63) / 64);
+	return [a = std::move(a), b = std::move(b), mask]() mutable {
+		compareToBitmask(CompareOp::Greater, a.data(), b.data(), a.size(), mask.data());
+		doNotOptimize(mask.data());
+	};
+});
+
+// Lambda.cpp: evaluating lambda one point at a time through std::function and in batch
+std::vector<double> makePoints()
+{
+	std::vector<double> in(1000000);
+	for (std::size_t i = 0; i < in.size(); i++)
+		in[i] = i * 0.001;
+	return in;
+}
+
+Registrar lambdaBenchmark("Lambda", 1, []() {
+	std::function<double(double)> f = [](double x) { return 3 * x * x + 2 * x + 1; };
+	return [in = makePoints(), f]() {
+		double sum = 0;
+		for (double x : in)
+			sum += eval(f, x);
+		doNotOptimize(sum);
+	};
+});
+
+Registrar lambdaBatchBenchmark("LambdaBatch", 1, []() {
+	batch_function f = [](double x) { return 3 * x * x + 2 * x + 1; };
+	std::vector<double> in = makePoints();
+	std::vector<double> out(in.size());
+	return [in = std::move(in), out, f]() mutable {
+		eval(f, in, out);
+		doNotOptimize(out.data());
+	};
+});
+
+
+struct Result
+{
+	double medianNs; // per iteration
+	double minNs;
+	unsigned repetitions;
+};
+
+Result run(const Benchmark& benchmark, unsigned warmup, unsigned repetitions, std::chrono::milliseconds minTime)
+{
+	auto body = benchmark.setup();
+	auto timeIterations = [&body](unsigned iterations) {
+		auto t0 = std::chrono::steady_clock::now();
+		for (unsigned i = 0; i < iterations; i++)
+			body();
+		return std::chrono::steady_clock::now() - t0;
+	};
+
+	// short repetitions are dominated by timer resolution and by noise like interrupts, so scale iterations up to minTime
+	unsigned iterations = std::max(1u, benchmark.iterations);
+	for (auto elapsed = timeIterations(iterations); elapsed < minTime && iterations < (1u << 30); elapsed = timeIterations(iterations)) {
+		const double factor = elapsed.count() > 0 ? 1.2 * minTime / elapsed : 10.0;
+		iterations = static_cast<unsigned>(std::min(iterations * std::clamp(factor, 2.0, 10.0), double(1u << 30)));
+	}
+
+	for (unsigned w = 0; w < warmup; w++)
+		timeIterations(iterations);
+
+	std::vector<double> times;
+	for (unsigned r = 0; r < repetitions; r++)
+		times.push_back(std::chrono::duration<double, std::nano>(timeIterations(iterations)).count() / iterations);
+
+	// median is less sensitive to occasional interrupts / frequency changes than mean
+	std::sort(times.begin(), times.end());
+	return { times[times.size() / 2], times.front(), repetitions };
+}
+
+void saveBaseline(const std::string& file, const std::map<std::string, Result>& results)
+{
+	std::ofstream out(file);
+	out << "{" << std::endl << "  \"benchmarks\": [" << std::endl;
+	for (auto it = results.begin(); it != results.end(); ++it) {
+		out << "    { \"name\": \"" << it->first << "\", \"median_ns\": " << std::setprecision(17) << it->second.medianNs
+			<< ", \"min_ns\": " << it->second.minNs << ", \"repetitions\": " << it->second.repetitions << " }"
+			<< (std::next(it) == results.end() ? "" : ",") << std::endl;
+	}
+	out << "  ]" << std::endl << "}" << std::endl;
+}
+
+// reads only what saveBaseline writes, not a general JSON parser
+std::map<std::string, Result> loadBaseline(const std::string& file)
+{
+	std::ifstream in(file);
+	std::stringstream buffer;
+	buffer << in.rdbuf();
+	const std::string text = buffer.str();
+
+	auto numberAfter = [&text](const std::string& key, std::size_t from, std::size_t to) {
+		std::size_t pos = text.find("\"" + key + "\":", from);
+		return pos < to ? std::strtod(text.c_str() + pos + key.size() + 3, nullptr) : 0.0;
+	};
+
+	std::map<std::string, Result> results;
+	for (std::size_t pos = text.find("{", text.find("[")); pos != std::string::npos; pos = text.find("{", pos + 1)) {
+		const std::size_t end = text.find("}", pos);
+		const std::size_t nameStart = text.find("\"name\": \"", pos);
+		if (end == std::string::npos || nameStart > end)
+			break;
+		const std::size_t valueStart = nameStart + std::strlen("\"name\": \"");
+		const std::string name = text.substr(valueStart, text.find("\"", valueStart) - valueStart);
+		results[name] = { numberAfter("median_ns", pos, end), numberAfter("min_ns", pos, end), static_cast<unsigned>(numberAfter("repetitions", pos, end)) };
+	}
+	return results;
+}
+
+// prints every benchmark next to its baseline, returns number of regressions
+unsigned compareWithBaseline(const std::map<std::string, Result>& results, const std::map<std::string, Result>& baseline, double thresholdPercent)
+{
+	unsigned regressions = 0;
+	std::cout << std::endl << "Comparison with baseline (threshold " << thresholdPercent << "%)" << std::endl;
+	std::cout << std::left << std::setw(16) << "benchmark" << std::right << std::setw(16) << "baseline ns" << std::setw(16) << "current ns" << std::setw(10) << "change" << std::endl;
+	for (auto& [name, result] : results) {
+		auto it = baseline.find(name);
+		if (it == baseline.end() || it->second.medianNs <= 0) {
+			std::cout << std::left << std::setw(16) << name << std::right << std::setw(16) << "-" << std::setw(16) << result.medianNs << "  (not in baseline)" << std::endl;
+			continue;
+		}
+		const double change = (result.medianNs - it->second.medianNs) / it->second.medianNs * 100;
+		// median alone may move by more than threshold because of few noisy repetitions,
+		// if even the fastest repetition is slower than baseline median code really got slower
+		const bool regressed = change > thresholdPercent && result.minNs > it->second.medianNs;
+		regressions += regressed;
+		std::cout << std::left << std::setw(16) << name << std::right << std::setw(16) << it->second.medianNs << std::setw(16) << result.medianNs
+			<< std::setw(9) << std::showpos << std::fixed << std::setprecision(1) << change << "%" << std::noshowpos << std::defaultfloat << std::setprecision(6)
+			<< (regressed ? "  REGRESSION" : "") << std::endl;
+	}
+	for (auto& [name, result] : baseline)
+		if (results.find(name) == results.end())
+			std::cout << std::left << std::setw(16) << name << std::right << std::setw(16) << result.medianNs << std::setw(16) << "-" << "  (not run)" << std::endl;
+	return regressions;
+}
+
+int main(int argc, char* argv[])
+{
+	std::string filter, saveFile, baselineFile;
+	int cpu = -1;
+	unsigned warmup = 2, repetitions = 11;
+	std::chrono::milliseconds minTime(20);
+	double threshold = 10.0;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (i + 1 >= argc) {
+			std::cerr << "missing value for " << arg << std::endl;
+			return 2;
+		}
+		std::string value = argv[++i];
+		if (arg == "--filter") filter = value;
+		else if (arg == "--cpu") cpu = std::stoi(value);
+		else if (arg == "--warmup") warmup = std::stoul(value);
+		else if (arg == "--repetitions") repetitions = std::max(1ul, std::stoul(value));
+		else if (arg == "--min-time") minTime = std::chrono::milliseconds(std::stoul(value));
+		else if (arg == "--save") saveFile = value;
+		else if (arg == "--baseline") baselineFile = value;
+		else if (arg == "--threshold") threshold = std::stod(value);
+		else {
+			std::cerr << "unknown argument " << arg << std::endl;
+			return 2;
+		}
+	}
+
+	// running on one core avoids migrations between cores with different caches / frequencies
+	if (cpu >= 0 && !pinToCpu(cpu))
+		std::cerr << "could not pin to cpu " << cpu << std::endl;
+
+	std::map<std::string, Result> results;
+	std::cout << std::left << std::setw(16) << "benchmark" << std::right << std::setw(16) << "median ns" << std::setw(16) << "min ns" << std::endl;
+	for (auto& benchmark : registry()) {
+		if (!filter.empty() && benchmark.name.find(filter) == std::string::npos)
+			continue;
+		Result result = run(benchmark, warmup, repetitions, minTime);
+		results[benchmark.name] = result;
+		std::cout << std::left << std::setw(16) << benchmark.name << std::right << std::setw(16) << result.medianNs << std::setw(16) << result.minNs << std::endl;
+	}
+
+	if (!saveFile.empty())
+		saveBaseline(saveFile, results);
+
+	if (!baselineFile.empty()) {
+		auto baseline = loadBaseline(baselineFile);
+		if (baseline.empty()) {
+			std::cerr << "could not read baseline " << baselineFile << std::endl;
+			return 2;
+		}
+		unsigned regressions = compareWithBaseline(results, baseline, threshold);
+		if (regressions > 0) {
+			std::cout << regressions << " benchmark(s) regressed" << std::endl;
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -2,89 +2,356 @@
 //
 
 #include <iostream>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <new>
 
-struct WrapperTwo
+#include "Comparison.h"
+
+// transparent comparator, is_transparent lets std::set::find and friends take WrapperTwo directly without building a temporary WrapperOne
+// only w1 < w2 and w1 > w2 forms are used so it works both with <=> and with C++17 operators in Comparison.h
+struct WrapperLess
 {
-	int y;
+	using is_transparent = void;
+
+	bool operator()(const WrapperOne& a, const WrapperOne& b) const { return a.x < b.x; }
+	bool operator()(const WrapperOne& a, const WrapperTwo& b) const { return a < b; }
+	bool operator()(const WrapperTwo& a, const WrapperOne& b) const { return b > a; }
 };
 
-struct WrapperOne
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define PREFETCH(addr)
+#endif
+
+// allocates on cache line boundary, so that position known to start a cache line in the index also does in memory
+template <class T>
+struct CacheLineAllocator
 {
-	int x;
+	using value_type = T;
+	static constexpr std::size_t CACHE_LINE = 64;
+
+	CacheLineAllocator() = default;
+	template <class U> CacheLineAllocator(const CacheLineAllocator<U>&) {}
+
+	T* allocate(std::size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{ CACHE_LINE })); }
+	void deallocate(T* p, std::size_t) { ::operator delete(p, std::align_val_t{ CACHE_LINE }); }
+
+	template <class U> bool operator==(const CacheLineAllocator<U>&) const { return true; }
+	template <class U> bool operator!=(const CacheLineAllocator<U>&) const { return false; }
 };
 
-bool operator==(const WrapperOne& w1, const WrapperTwo& w2)
+// sorted index kept in one flat array instead of tree nodes
+// Sorted layout is ordinary sorted array searched with branchless binary search
+// Eytzinger layout stores the implicit binary search tree in BFS order (children of k are 2k and 2k+1), top levels of the tree share few cache lines
+// and descendants few levels down are contiguous so they can be prefetched
+template <class Key, class Compare>
+class FlatSortedIndex
 {
-	return w1.x == w2.y;
-}
+public:
+	enum class Layout { Sorted, Eytzinger };
 
-#ifdef __cpp_lib_three_way_comparison
-std::strong_ordering operator<=>(const WrapperOne& w1, const WrapperTwo& w2)
-{
-	return w1.x <=> w2.y;
-}
-#endif
+	FlatSortedIndex(std::vector<Key> keys, Layout layout_ = Layout::Sorted) : layout(layout_), size(keys.size())
+	{
+		std::sort(keys.begin(), keys.end(), comp);
+		keys.erase(std::unique(keys.begin(), keys.end(), [this](const Key& a, const Key& b) { return !comp(a, b) && !comp(b, a); }), keys.end());
+		size = keys.size();
 
-#ifndef __cpp_lib_three_way_comparison
-// for C++17 and earlier in addition to == we need !=, <, <=, >, >= and asymmetric versions of each
+		if (layout == Layout::Sorted) {
+			data.assign(keys.begin(), keys.end());
+		}
+		else {
+			// index 0 is unused so that root is 1, it also serves as "not found" position
+			data.resize(size + 1);
+			std::size_t i = 0;
+			buildEytzinger(keys, i, 1);
+		}
+	}
 
-bool operator==(const WrapperTwo& w2, const WrapperOne& w1)
-{
-	return w1 == w2;
-}
+	// returns pointer to the matching key or nullptr
+	template <class Query>
+	const Key* find(const Query& query) const
+	{
+		const Key* result = layout == Layout::Sorted ? lowerBoundSorted(query) : lowerBoundEytzinger(query);
+		return (result != nullptr && !comp(query, *result)) ? result : nullptr;
+	}
 
-bool operator!=(const WrapperOne& w1, const WrapperTwo& w2)
-{
-	return w1.x != w2.y;
-}
+	// looks up count queries, searches for a group of queries are interleaved so their cache misses overlap
+	template <class Query>
+	void findBatch(const Query* queries, std::size_t count, const Key** results) const
+	{
+		for (std::size_t first = 0; first < count; first += GROUP) {
+			const std::size_t n = std::min(GROUP, count - first);
+			if (layout == Layout::Sorted)
+				batchSorted(queries + first, n, results + first);
+			else
+				batchEytzinger(queries + first, n, results + first);
+			for (std::size_t i = first; i < first + n; i++)
+				if (results[i] != nullptr && comp(queries[i], *results[i]))
+					results[i] = nullptr;
+		}
+	}
 
-bool operator!=(const WrapperTwo& w2, const WrapperOne& w1)
-{
-	return w1 != w2;
-}
+private:
+	// number of queries searched together by findBatch
+	static constexpr std::size_t GROUP = 16;
 
-bool operator<(const WrapperOne& w1, const WrapperTwo& w2)
-{
-	return w1.x < w2.y;
-}
+	// how many keys fit into a cache line, descendants of k that are log2(KEYS_PER_LINE) levels down are contiguous starting at
+	// k * KEYS_PER_LINE, as data is cache line aligned (and key size divides 64) that position starts a cache line
+	// so prefetching it brings all of them in with one cache line
+	static constexpr std::size_t KEYS_PER_LINE = sizeof(Key) < 64 ? 64 / sizeof(Key) : 1;
 
-bool operator<=(const WrapperOne& w1, const WrapperTwo& w2)
-{
-	return w1 < w2 || w1 == w2;
-}
+	void buildEytzinger(const std::vector<Key>& sorted, std::size_t& i, std::size_t k)
+	{
+		if (k <= size) {
+			buildEytzinger(sorted, i, 2 * k);
+			data[k] = sorted[i++];
+			buildEytzinger(sorted, i, 2 * k + 1);
+		}
+	}
 
-bool operator>(const WrapperOne& w1, const WrapperTwo& w2)
-{
-	return !(w1 < w2) && w1 != w2;
-}
+	template <class Query>
+	const Key* lowerBoundSorted(const Query& query) const
+	{
+		if (size == 0)
+			return nullptr;
+		const Key* base = data.data();
+		std::size_t len = size;
+		while (len > 1) {
+			const std::size_t half = len / 2;
+			base = comp(base[half - 1], query) ? base + half : base; // compiles to cmov instead of branch
+			len -= half;
+		}
+		base += comp(*base, query);
+		return base == data.data() + size ? nullptr : base;
+	}
 
-bool operator>=(const WrapperOne& w1, const WrapperTwo& w2)
+	// going left/right is 2k + (key < query), after falling out of the tree lower bound is the last node where we went left
+	// i.e. strip trailing ones (right turns) and then one more bit
+	static std::size_t eytzingerResult(std::size_t k)
+	{
+		while (k & 1)
+			k >>= 1;
+		return k >> 1;
+	}
+
+	template <class Query>
+	const Key* lowerBoundEytzinger(const Query& query) const
+	{
+		std::size_t k = 1;
+		while (k <= size) {
+			PREFETCH(data.data() + std::min(k * KEYS_PER_LINE, size));
+			k = 2 * k + comp(data[k], query);
+		}
+		k = eytzingerResult(k);
+		return k == 0 ? nullptr : &data[k];
+	}
+
+	template <class Query>
+	void batchSorted(const Query* queries, std::size_t n, const Key** results) const
+	{
+		if (size == 0) {
+			std::fill(results, results + n, nullptr);
+			return;
+		}
+		// branchless search takes the same number of steps for every query so whole group can move one level at a time
+		const Key* base[GROUP];
+		std::fill(base, base + n, data.data());
+		std::size_t len = size;
+		while (len > 1) {
+			const std::size_t half = len / 2;
+			// next step probes nextHalf - 1 past the new base, which is either base or base + half
+			const std::size_t nextHalf = (len - half) / 2;
+			for (std::size_t i = 0; i < n; i++) {
+				if (nextHalf > 0) {
+					PREFETCH(base[i] + nextHalf - 1);
+					PREFETCH(base[i] + half + nextHalf - 1);
+				}
+				base[i] = comp(base[i][half - 1], queries[i]) ? base[i] + half : base[i];
+			}
+			len -= half;
+		}
+		for (std::size_t i = 0; i < n; i++) {
+			const Key* r = base[i] + comp(*base[i], queries[i]);
+			results[i] = r == data.data() + size ? nullptr : r;
+		}
+	}
+
+	template <class Query>
+	void batchEytzinger(const Query* queries, std::size_t n, const Key** results) const
+	{
+		std::size_t k[GROUP];
+		std::fill(k, k + n, 1);
+		// depth of every leaf is either floor(log2(size)) or one more, so iterate while any query is still inside the tree
+		bool active = size > 0;
+		while (active) {
+			active = false;
+			for (std::size_t i = 0; i < n; i++) {
+				if (k[i] <= size) {
+					PREFETCH(data.data() + std::min(k[i] * KEYS_PER_LINE, size));
+					k[i] = 2 * k[i] + comp(data[k[i]], queries[i]);
+					active = true;
+				}
+			}
+		}
+		for (std::size_t i = 0; i < n; i++) {
+			const std::size_t r = size > 0 ? eytzingerResult(k[i]) : 0;
+			results[i] = r == 0 ? nullptr : &data[r];
+		}
+	}
+
+	Compare comp;
+	Layout layout;
+	std::size_t size;
+	std::vector<Key, CacheLineAllocator<Key>> data;
+};
+
+template <class F>
+void benchmarkLookup(const char* name, std::size_t numQueries, F lookup)
 {
-	return !(w1 < w2);
+	auto t0 = std::chrono::high_resolution_clock::now();
+	std::size_t found = lookup();
+	auto t1 = std::chrono::high_resolution_clock::now();
+	std::cout << "  " << name << ": " << std::chrono::duration<double, std::nano>(t1 - t0).count() / numQueries << " ns/lookup, found " << found << std::endl;
 }
 
-bool operator<(const WrapperTwo& w2, const WrapperOne& w1)
+// keys are even numbers so that roughly half of random queries are misses
+void benchmarkIndex(std::size_t numKeys, std::size_t numQueries)
 {
-	return w1 >= w2;
+	std::cout << std::endl << numKeys << " keys" << std::endl;
+
+	std::mt19937 mersenne_engine{ 42 };
+	std::vector<WrapperOne> keys(numKeys);
+	for (std::size_t i = 0; i < numKeys; i++)
+		keys[i].x = static_cast<int>(2 * i);
+	std::shuffle(keys.begin(), keys.end(), mersenne_engine);
+
+	std::uniform_int_distribution<int> dist(0, static_cast<int>(2 * numKeys));
+	std::vector<WrapperTwo> queries(numQueries);
+	for (auto& q : queries)
+		q.y = dist(mersenne_engine);
+
+	// std::set is a node per key, beyond this it does not fit into memory of a typical machine
+	if (numKeys <= 10000000) {
+		std::set<WrapperOne, WrapperLess> set(keys.begin(), keys.end());
+		benchmarkLookup("std::set", numQueries, [&]() {
+			std::size_t found = 0;
+			for (auto& q : queries)
+				found += set.find(q) != set.end();
+			return found;
+		});
+	}
+
+	{
+		std::vector<WrapperOne> sorted = keys;
+		std::sort(sorted.begin(), sorted.end(), WrapperLess());
+		benchmarkLookup("std::lower_bound", numQueries, [&]() {
+			std::size_t found = 0;
+			for (auto& q : queries) {
+				auto it = std::lower_bound(sorted.begin(), sorted.end(), q, WrapperLess());
+				found += it != sorted.end() && *it == q;
+			}
+			return found;
+		});
+	}
+
+	std::vector<const WrapperOne*> results(numQueries);
+	for (auto layout : { FlatSortedIndex<WrapperOne, WrapperLess>::Layout::Sorted, FlatSortedIndex<WrapperOne, WrapperLess>::Layout::Eytzinger }) {
+		FlatSortedIndex<WrapperOne, WrapperLess> index(keys, layout);
+		const bool sortedLayout = layout == FlatSortedIndex<WrapperOne, WrapperLess>::Layout::Sorted;
+
+		benchmarkLookup(sortedLayout ? "flat sorted" : "flat eytzinger", numQueries, [&]() {
+			std::size_t found = 0;
+			for (auto& q : queries)
+				found += index.find(q) != nullptr;
+			return found;
+		});
+
+		benchmarkLookup(sortedLayout ? "flat sorted batch" : "flat eytzinger batch", numQueries, [&]() {
+			index.findBatch(queries.data(), queries.size(), results.data());
+			return static_cast<std::size_t>(std::count_if(results.begin(), results.end(), [](const WrapperOne* r) { return r != nullptr; }));
+		});
+	}
 }
 
-bool operator<=(const WrapperTwo& w2, const WrapperOne& w1)
+// one pair at a time through the operators, used both as reference for verification and as benchmark baseline
+template <CompareOp Op>
+void compareOneByOne(const WrapperOne* a, const WrapperTwo* b, std::size_t count, std::uint64_t* mask)
 {
-	return w1 > w2;
+	std::fill(mask, mask + (count + 63) / 64, 0);
+	for (std::size_t i = 0; i < count; i++)
+		if (compareScalar<Op>(a[i], b[i]))
+			mask[i / 64] |= std::uint64_t(1) << (i % 64);
 }
 
-bool operator>(const WrapperTwo& w2, const WrapperOne& w1)
+template <CompareOp Op>
+void benchmarkCompare(const char* name, const std::vector<WrapperOne>& a, const std::vector<WrapperTwo>& b)
 {
-	return w1 <= w2;
+	const std::size_t count = a.size();
+	std::vector<std::uint64_t> expected((count + 63) / 64), mask((count + 63) / 64);
+	std::vector<std::uint32_t> selection(count);
+
+	auto t0 = std::chrono::high_resolution_clock::now();
+	compareOneByOne<Op>(a.data(), b.data(), count, expected.data());
+	auto t1 = std::chrono::high_resolution_clock::now();
+	compareToBitmask(Op, a.data(), b.data(), count, mask.data());
+	auto t2 = std::chrono::high_resolution_clock::now();
+	std::size_t selected = compareToSelection(Op, a.data(), b.data(), count, selection.data());
+	auto t3 = std::chrono::high_resolution_clock::now();
+
+	// span against scalar, checked against the same operator with b[0] repeated
+	std::vector<WrapperTwo> repeated(count, b[0]);
+	std::vector<std::uint64_t> expectedScalar((count + 63) / 64), maskScalar((count + 63) / 64);
+	compareOneByOne<Op>(a.data(), repeated.data(), count, expectedScalar.data());
+	compareToBitmask(Op, a.data(), b[0], count, maskScalar.data());
+	std::vector<std::uint32_t> selectionScalar(count), expectedSelectionScalar(count);
+	std::size_t selectedScalar = compareToSelection(Op, a.data(), b[0], count, selectionScalar.data());
+	std::size_t expectedSelectedScalar = bitmaskToSelection(expectedScalar.data(), count, expectedSelectionScalar.data());
+
+	std::size_t expectedSelected = 0;
+	bool selectionOk = true;
+	for (std::size_t i = 0; i < count; i++) {
+		if (compareScalar<Op>(a[i], b[i]))
+			selectionOk = selectionOk && expectedSelected < selected && selection[expectedSelected++] == i;
+	}
+	selectionOk = selectionOk && expectedSelected == selected;
+	selectionOk = selectionOk && selectedScalar == expectedSelectedScalar && selectionScalar == expectedSelectionScalar;
+
+	auto perSecond = [count](auto from, auto to) { return count / std::chrono::duration<double>(to - from).count(); };
+	std::cout << "  " << name << ": one by one " << perSecond(t0, t1) << ", bitmask " << perSecond(t1, t2) << ", selection " << perSecond(t2, t3)
+		<< " comparisons/sec, verified " << (mask == expected && maskScalar == expectedScalar && selectionOk) << std::endl;
 }
 
-bool operator>=(const WrapperTwo& w2, const WrapperOne& w1)
+void benchmarkCompares(std::size_t count)
 {
-	return w1 < w2;
+	std::cout << std::endl << "Batch comparison of " << count << " pairs" << std::endl;
+
+	// narrow value range so that equality holds often enough to matter
+	std::mt19937 mersenne_engine{ 42 };
+	std::uniform_int_distribution<int> dist(-100, 100);
+	std::vector<WrapperOne> a(count);
+	std::vector<WrapperTwo> b(count);
+	for (std::size_t i = 0; i < count; i++) {
+		a[i].x = dist(mersenne_engine);
+		b[i].y = dist(mersenne_engine);
+	}
+
+	benchmarkCompare<CompareOp::Equal>("==", a, b);
+	benchmarkCompare<CompareOp::NotEqual>("!=", a, b);
+	benchmarkCompare<CompareOp::Less>("<", a, b);
+	benchmarkCompare<CompareOp::LessEqual>("<=", a, b);
+	benchmarkCompare<CompareOp::Greater>(">", a, b);
+	benchmarkCompare<CompareOp::GreaterEqual>(">=", a, b);
 }
-#endif
 
-int main()
+int main(int argc, char* argv[])
 {
 	WrapperOne w1{ 1 };
 	WrapperTwo w2{ 2 };
@@ -102,5 +369,14 @@ int main()
 	std::cout << (w2 >= w1) << std::endl;
 	std::cout << (w2 == w1) << std::endl;
 	std::cout << (w2 != w1) << std::endl;
+
+	// optional argument is the largest index size to benchmark, e.g. 100000000
+	const std::size_t maxKeys = argc > 1 ? std::stoull(argv[1]) : 10000000;
+	const std::size_t NUM_QUERIES = 1000000;
+	for (std::size_t numKeys = 1000000; numKeys <= maxKeys; numKeys *= 10)
+		benchmarkIndex(numKeys, NUM_QUERIES);
+
+	// odd count so that scalar tail is exercised as well
+	benchmarkCompares(10000003);
 }
 
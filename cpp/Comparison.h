@@ -0,0 +1,245 @@
+// WrapperOne / WrapperTwo with their comparisons and batch comparison kernels, shared by Comparison.cpp and Benchmark.cpp
+
+#pragma once
+
+#if __has_include(<version>)
+#include <version>
+#endif
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#ifdef __cpp_lib_three_way_comparison
+#include <compare>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COMPARISON_SSE2
+#endif
+
+struct WrapperTwo
+{
+	int y;
+};
+
+struct WrapperOne
+{
+	int x;
+};
+
+inline bool operator==(const WrapperOne& w1, const WrapperTwo& w2)
+{
+	return w1.x == w2.y;
+}
+
+#ifdef __cpp_lib_three_way_comparison
+inline std::strong_ordering operator<=>(const WrapperOne& w1, const WrapperTwo& w2)
+{
+	return w1.x <=> w2.y;
+}
+#endif
+
+#ifndef __cpp_lib_three_way_comparison
+// for C++17 and earlier in addition to == we need !=, <, <=, >, >= and asymmetric versions of each
+
+inline bool operator==(const WrapperTwo& w2, const WrapperOne& w1)
+{
+	return w1 == w2;
+}
+
+inline bool operator!=(const WrapperOne& w1, const WrapperTwo& w2)
+{
+	return w1.x != w2.y;
+}
+
+inline bool operator!=(const WrapperTwo& w2, const WrapperOne& w1)
+{
+	return w1 != w2;
+}
+
+inline bool operator<(const WrapperOne& w1, const WrapperTwo& w2)
+{
+	return w1.x < w2.y;
+}
+
+inline bool operator<=(const WrapperOne& w1, const WrapperTwo& w2)
+{
+	return w1 < w2 || w1 == w2;
+}
+
+inline bool operator>(const WrapperOne& w1, const WrapperTwo& w2)
+{
+	return !(w1 < w2) && w1 != w2;
+}
+
+inline bool operator>=(const WrapperOne& w1, const WrapperTwo& w2)
+{
+	return !(w1 < w2);
+}
+
+inline bool operator<(const WrapperTwo& w2, const WrapperOne& w1)
+{
+	return w1 >= w2;
+}
+
+inline bool operator<=(const WrapperTwo& w2, const WrapperOne& w1)
+{
+	return w1 > w2;
+}
+
+inline bool operator>(const WrapperTwo& w2, const WrapperOne& w1)
+{
+	return w1 <= w2;
+}
+
+inline bool operator>=(const WrapperTwo& w2, const WrapperOne& w1)
+{
+	return w1 < w2;
+}
+#endif
+
+// batch comparison of whole columns, a[i] is compared either with b[i] or with single b
+// result is either a bitmask (bit i of word i / 64 is set when comparison holds) or a selection vector (indices where comparison holds)
+enum class CompareOp { Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual };
+
+// wrappers are just an int so columns of them can be loaded directly into SIMD registers
+static_assert(sizeof(WrapperOne) == sizeof(int) && sizeof(WrapperTwo) == sizeof(int), "wrappers must be plain int");
+
+template <CompareOp Op>
+bool compareScalar(const WrapperOne& w1, const WrapperTwo& w2)
+{
+	if constexpr (Op == CompareOp::Equal) return w1 == w2;
+	else if constexpr (Op == CompareOp::NotEqual) return w1 != w2;
+	else if constexpr (Op == CompareOp::Less) return w1 < w2;
+	else if constexpr (Op == CompareOp::LessEqual) return w1 <= w2;
+	else if constexpr (Op == CompareOp::Greater) return w1 > w2;
+	else return w1 >= w2;
+}
+
+#ifdef COMPARISON_SSE2
+// SSE2 has only ==, < and > for signed ints, the rest are negations, returns 4 bits one per lane
+template <CompareOp Op>
+unsigned compareSimd(__m128i a, __m128i b)
+{
+	__m128i m;
+	if constexpr (Op == CompareOp::Equal || Op == CompareOp::NotEqual) m = _mm_cmpeq_epi32(a, b);
+	else if constexpr (Op == CompareOp::Less || Op == CompareOp::GreaterEqual) m = _mm_cmplt_epi32(a, b);
+	else m = _mm_cmpgt_epi32(a, b);
+
+	unsigned bits = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(m)));
+	if constexpr (Op == CompareOp::NotEqual || Op == CompareOp::GreaterEqual || Op == CompareOp::LessEqual)
+		bits ^= 0xF;
+	return bits;
+}
+#endif
+
+template <CompareOp Op, bool ScalarB>
+void compareKernel(const WrapperOne* a, const WrapperTwo* b, std::size_t count, std::uint64_t* mask)
+{
+	std::size_t i = 0;
+#ifdef COMPARISON_SSE2
+	// b is touched only when there is something to compare, empty column may come with null pointer
+	__m128i scalarB = _mm_setzero_si128();
+	if constexpr (ScalarB) {
+		if (count >= 64)
+			scalarB = _mm_set1_epi32(b->y);
+	}
+	for (; i + 64 <= count; i += 64) {
+		std::uint64_t word = 0;
+		for (unsigned j = 0; j < 64; j += 4) {
+			__m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + j));
+			__m128i vb;
+			if constexpr (ScalarB)
+				vb = scalarB;
+			else
+				vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + j));
+			word |= static_cast<std::uint64_t>(compareSimd<Op>(va, vb)) << j;
+		}
+		mask[i / 64] = word;
+	}
+#endif
+	// scalar fallback, also handles the tail
+	for (; i < count; i += 64) {
+		std::uint64_t word = 0;
+		const std::size_t n = std::min<std::size_t>(64, count - i);
+		for (std::size_t j = 0; j < n; j++)
+			word |= static_cast<std::uint64_t>(compareScalar<Op>(a[i + j], ScalarB ? *b : b[i + j])) << j;
+		mask[i / 64] = word;
+	}
+}
+
+template <bool ScalarB>
+void compareDispatch(CompareOp op, const WrapperOne* a, const WrapperTwo* b, std::size_t count, std::uint64_t* mask)
+{
+	switch (op) {
+	case CompareOp::Equal: compareKernel<CompareOp::Equal, ScalarB>(a, b, count, mask); break;
+	case CompareOp::NotEqual: compareKernel<CompareOp::NotEqual, ScalarB>(a, b, count, mask); break;
+	case CompareOp::Less: compareKernel<CompareOp::Less, ScalarB>(a, b, count, mask); break;
+	case CompareOp::LessEqual: compareKernel<CompareOp::LessEqual, ScalarB>(a, b, count, mask); break;
+	case CompareOp::Greater: compareKernel<CompareOp::Greater, ScalarB>(a, b, count, mask); break;
+	case CompareOp::GreaterEqual: compareKernel<CompareOp::GreaterEqual, ScalarB>(a, b, count, mask); break;
+	}
+}
+
+// mask has to hold (count + 63) / 64 words
+inline void compareToBitmask(CompareOp op, const WrapperOne* a, const WrapperTwo* b, std::size_t count, std::uint64_t* mask)
+{
+	compareDispatch<false>(op, a, b, count, mask);
+}
+
+inline void compareToBitmask(CompareOp op, const WrapperOne* a, const WrapperTwo& b, std::size_t count, std::uint64_t* mask)
+{
+	compareDispatch<true>(op, a, &b, count, mask);
+}
+
+inline unsigned countTrailingZeros(std::uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+	unsigned n = 0;
+	for (; !(word & 1); word >>= 1)
+		n++;
+	return n;
+#endif
+}
+
+// selection has to hold count indices, returns number of selected ones
+inline std::size_t bitmaskToSelection(const std::uint64_t* mask, std::size_t count, std::uint32_t* selection)
+{
+	assert(count <= UINT32_MAX); // indices are 32 bit
+	std::size_t selected = 0;
+	for (std::size_t w = 0; w < (count + 63) / 64; w++) {
+		for (std::uint64_t word = mask[w]; word != 0; word &= word - 1)
+			selection[selected++] = static_cast<std::uint32_t>(w * 64 + countTrailingZeros(word));
+	}
+	return selected;
+}
+
+// compares one 64 element block at a time and turns it into indices right away, so no bitmask for the whole column is needed
+template <bool ScalarB>
+std::size_t selectDispatch(CompareOp op, const WrapperOne* a, const WrapperTwo* b, std::size_t count, std::uint32_t* selection)
+{
+	assert(count <= UINT32_MAX); // indices are 32 bit
+	std::size_t selected = 0;
+	for (std::size_t i = 0; i < count; i += 64) {
+		std::uint64_t word;
+		compareDispatch<ScalarB>(op, a + i, ScalarB ? b : b + i, std::min<std::size_t>(64, count - i), &word);
+		for (; word != 0; word &= word - 1)
+			selection[selected++] = static_cast<std::uint32_t>(i + countTrailingZeros(word));
+	}
+	return selected;
+}
+
+// selection has to hold count indices, returns number of selected ones
+inline std::size_t compareToSelection(CompareOp op, const WrapperOne* a, const WrapperTwo* b, std::size_t count, std::uint32_t* selection)
+{
+	return selectDispatch<false>(op, a, b, count, selection);
+}
+
+inline std::size_t compareToSelection(CompareOp op, const WrapperOne* a, const WrapperTwo& b, std::size_t count, std::uint32_t* selection)
+{
+	return selectDispatch<true>(op, a, &b, count, selection);
+}
@@ -2,6 +2,15 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
+#include <thread>
+#include <chrono>
+#include <tuple>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <limits>
+
+#include "Lambda.h"
 
 class enclosing 
 {
@@ -46,11 +55,127 @@ struct ClassMember {
 	}
 };
 
-double eval(std::function <double(double)> f, double x = 2.0)
+// lazy pipeline, stages only store the lambdas, nothing is evaluated until a terminal operation (for_each or reduce) is called
+// the terminal operation runs a single pass, every element is pushed through all the stages so no intermediate containers are created
+template <class Pred>
+struct filter_stage
+{
+	Pred pred;
+
+	template <class T, class Next>
+	void apply(T&& value, Next&& next) const
+	{
+		if (pred(value))
+			next(std::forward<T>(value));
+	}
+};
+
+template <class Fn>
+struct transform_stage
+{
+	Fn fn;
+
+	template <class T, class Next>
+	void apply(T&& value, Next&& next) const
+	{
+		next(fn(std::forward<T>(value)));
+	}
+};
+
+template <class Pred> filter_stage<Pred> filter(Pred pred) { return { pred }; }
+template <class Fn> transform_stage<Fn> transform(Fn fn) { return { fn }; }
+
+template <class It, class... Stages>
+class pipeline
+{
+public:
+	pipeline(It first_, It last_, std::tuple<Stages...> stages_ = {}) : first(first_), last(last_), stages(stages_) {}
+
+	template <class Stage>
+	pipeline<It, Stages..., Stage> operator|(Stage stage) const
+	{
+		return { first, last, std::tuple_cat(stages, std::make_tuple(stage)) };
+	}
+
+	template <class Sink>
+	void for_each(Sink sink) const
+	{
+		run(first, last, sink);
+	}
+
+	template <class T, class Op>
+	T reduce(T init, Op op) const
+	{
+		run(first, last, [&init, &op](auto&& value) { init = op(init, value); });
+		return init;
+	}
+
+	// every chunk starts from its own first value, so unlike T{} no identity of op is needed and result is the same as of sequential reduce
+	// op has to be associative and commutative (same as for std::reduce)
+	template <class T, class Op>
+	T reduce(T init, Op op, unsigned numThreads) const
+	{
+		static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<It>::iterator_category>,
+			"parallel reduce requires random access iterators");
+
+		const std::size_t size = last - first;
+		if (numThreads <= 1 || size < numThreads)
+			return reduce(init, op);
+
+		std::vector<std::optional<T>> partial(numThreads);
+		std::vector<std::thread> threads;
+		const std::size_t chunk = size / numThreads;
+		for (unsigned t = 0; t < numThreads; t++) {
+			It chunkFirst = first + t * chunk;
+			It chunkLast = (t == numThreads - 1) ? last : chunkFirst + chunk;
+			threads.emplace_back([this, &partial, &op, t, chunkFirst, chunkLast]() {
+				std::optional<T> acc;
+				run(chunkFirst, chunkLast, [&acc, &op](auto&& value) { acc = acc ? op(*acc, value) : T(value); });
+				partial[t] = acc;
+			});
+		}
+		for (auto& th : threads)
+			th.join();
+
+		// chunks where everything has been filtered out have nothing to contribute
+		for (auto& p : partial)
+			if (p)
+				init = op(init, *p);
+		return init;
+	}
+
+private:
+	template <class Sink>
+	void run(It from, It to, Sink sink) const
+	{
+		for (; from != to; ++from)
+			push<0>(*from, sink);
+	}
+
+	template <std::size_t I, class T, class Sink>
+	void push(T&& value, Sink& sink) const
+	{
+		if constexpr (I == sizeof...(Stages))
+			sink(std::forward<T>(value));
+		else
+			std::get<I>(stages).apply(std::forward<T>(value), [this, &sink](auto&& next) { push<I + 1>(std::forward<decltype(next)>(next), sink); });
+	}
+
+	It first;
+	It last;
+	std::tuple<Stages...> stages;
+};
+
+template <class Container>
+auto from(const Container& c)
 {
-	return f(x);
+	return pipeline<decltype(std::begin(c))>(std::begin(c), std::end(c));
 }
 
+// pipeline only stores iterators, so for temporary container they would dangle before terminal operation runs
+template <class Container>
+auto from(const Container&& c) = delete;
+
 int main()
 {
 	std::cout << "Ordinary lambda " << std::endl;
@@ -102,5 +227,78 @@ int main()
 	m1();                             // calls m2() and prints 123
 	std::cout << a << b << c << '\n'; // prints 234
 
+	std::cout << std::endl << "Batched evaluation" << std::endl;
+	const std::size_t NUM_POINTS = 10000000;
+	auto poly = [](double x) { return 3 * x * x + 2 * x + 1; };
+	std::vector<double> in(NUM_POINTS), out1(NUM_POINTS), out2(NUM_POINTS), out3(NUM_POINTS);
+	for (std::size_t i = 0; i < NUM_POINTS; i++)
+		in[i] = i * 0.001;
+
+	auto report = [NUM_POINTS](const char* name, auto t0, auto t1) {
+		double seconds = std::chrono::duration<double>(t1 - t0).count();
+		std::cout << name << ": " << NUM_POINTS / seconds << " points/sec" << std::endl;
+	};
+
+	std::function<double(double)> fpoly = poly;
+	auto t0 = std::chrono::high_resolution_clock::now();
+	for (std::size_t i = 0; i < NUM_POINTS; i++)
+		out1[i] = eval(fpoly, in[i]);
+	auto t1 = std::chrono::high_resolution_clock::now();
+	report("per element eval", t0, t1);
+
+	batch_function bpoly = poly;
+	t0 = std::chrono::high_resolution_clock::now();
+	eval(bpoly, in, out2);
+	t1 = std::chrono::high_resolution_clock::now();
+	report("batch eval", t0, t1);
+
+	unsigned numThreads = std::max(1u, std::thread::hardware_concurrency());
+	t0 = std::chrono::high_resolution_clock::now();
+	eval(bpoly, in, out3, numThreads);
+	t1 = std::chrono::high_resolution_clock::now();
+	report("batch eval on threads", t0, t1);
+
+	std::cout << "results match: " << (out1 == out2 && out1 == out3) << std::endl;
+
+	std::cout << std::endl << "Fused pipeline" << std::endl;
+	std::vector<int> vp = { 1, 2, 3, 4, 5, 6, 7 };
+	(from(vp) | filter([x](int n) { return n >= x; })).for_each([](int i) { std::cout << i << ' '; }); // same as remove_if, erase, for_each above without modifying vp
+	std::cout << std::endl;
+
+	const std::size_t NUM_VALUES = 10000000;
+	std::vector<int> values(NUM_VALUES);
+	for (std::size_t i = 0; i < NUM_VALUES; i++)
+		values[i] = static_cast<int>(i % 1000);
+	const int threshold = 500;
+
+	// STL, each algorithm is a separate pass over memory, remove_if modifies its input so it works on a copy made before timing
+	std::vector<int> filtered = values;
+	t0 = std::chrono::high_resolution_clock::now();
+	filtered.erase(std::remove_if(filtered.begin(), filtered.end(), [threshold](int n) { return n < threshold; }), filtered.end());
+	std::vector<long long> transformed(filtered.size());
+	std::transform(filtered.begin(), filtered.end(), transformed.begin(), [](int n) { return static_cast<long long>(n) * 5; });
+	long long stlTotal = std::accumulate(transformed.begin(), transformed.end(), 0LL);
+	t1 = std::chrono::high_resolution_clock::now();
+	std::cout << "STL algorithms: " << stlTotal << " in " << std::chrono::duration<float>(t1 - t0).count() << " seconds" << std::endl;
+
+	auto fused = from(values) | filter([threshold](int n) { return n >= threshold; }) | transform([](int n) { return static_cast<long long>(n) * 5; });
+
+	t0 = std::chrono::high_resolution_clock::now();
+	long long fusedTotal = fused.reduce(0LL, std::plus<>());
+	t1 = std::chrono::high_resolution_clock::now();
+	std::cout << "fused pipeline: " << fusedTotal << " in " << std::chrono::duration<float>(t1 - t0).count() << " seconds" << std::endl;
+
+	t0 = std::chrono::high_resolution_clock::now();
+	long long parallelTotal = fused.reduce(0LL, std::plus<>(), numThreads);
+	t1 = std::chrono::high_resolution_clock::now();
+	std::cout << "fused parallel pipeline: " << parallelTotal << " in " << std::chrono::duration<float>(t1 - t0).count() << " seconds" << std::endl;
+
+	// op without T{} as identity, max of only negative values must not become 0
+	auto negative = from(values) | transform([](int n) { return -n - 1; });
+	auto max = [](int a, int b) { return std::max(a, b); };
+	int sequentialMax = negative.reduce(std::numeric_limits<int>::min(), max);
+	int parallelMax = negative.reduce(std::numeric_limits<int>::min(), max, numThreads);
+	std::cout << "sequential and parallel max match: " << (sequentialMax == parallelMax && sequentialMax == -1) << std::endl;
+
 	return 0;
 }
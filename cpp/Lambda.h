@@ -0,0 +1,75 @@
+// evaluation of functions shared by Lambda.cpp and Benchmark.cpp, so that benchmark measures the same code the sample runs
+
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <span>
+#include <thread>
+#include <cassert>
+
+inline double eval(std::function <double(double)> f, double x = 2.0)
+{
+	return f(x);
+}
+
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+#define LAMBDA_RESTRICT __restrict
+#else
+#define LAMBDA_RESTRICT
+#endif
+
+// std::less gives total order also for pointers into different arrays, where plain < is unspecified
+inline bool overlaps(std::span<const double> in, std::span<double> out)
+{
+	std::less<const double*> less;
+	return !in.empty() && !out.empty() && less(in.data(), out.data() + out.size()) && less(out.data(), in.data() + in.size());
+}
+
+// std::function erases the type of the lambda so every eval call above goes through an indirect call which can not be inlined
+// batch_function erases the type only once per batch, the loop inside is instantiated for the concrete lambda so it can be inlined
+// in and out are promised not to overlap so the loop can be vectorized without runtime alias check (with g++ at -O3, -O2 cost model does not vectorize loops needing scalar epilogue)
+class batch_function
+{
+public:
+	template <class F>
+	batch_function(F f) : impl([f](const double* LAMBDA_RESTRICT in, double* LAMBDA_RESTRICT out, std::size_t n) {
+		for (std::size_t i = 0; i < n; i++)
+			out[i] = f(in[i]);
+	}) {}
+
+	// in and out must not overlap, evaluating in place is not supported
+	void operator()(std::span<const double> in, std::span<double> out) const
+	{
+		assert(in.size() == out.size());
+		assert(!overlaps(in, out));
+		impl(in.data(), out.data(), in.size());
+	}
+
+private:
+	std::function<void(const double*, double*, std::size_t)> impl;
+};
+
+// evaluates f for every element of in into out, in and out must be of the same size and must not overlap (no in place evaluation)
+inline void eval(const batch_function& f, std::span<const double> in, std::span<double> out, unsigned numThreads = 1)
+{
+	assert(in.size() == out.size());
+	assert(!overlaps(in, out));
+	if (numThreads <= 1 || in.size() < numThreads) {
+		f(in, out);
+		return;
+	}
+
+	// each thread gets one contiguous chunk, last one takes the remainder
+	std::vector<std::thread> threads;
+	const std::size_t chunk = in.size() / numThreads;
+	for (unsigned t = 0; t < numThreads; t++) {
+		const std::size_t first = t * chunk;
+		const std::size_t count = (t == numThreads - 1) ? in.size() - first : chunk;
+		threads.emplace_back([&f, in, out, first, count]() { f(in.subspan(first, count), out.subspan(first, count)); });
+	}
+	for (auto& th : threads)
+		th.join();
+}
+
+#undef LAMBDA_RESTRICT
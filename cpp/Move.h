@@ -0,0 +1,148 @@
+// classes of the move sample, shared by Move.cpp and Benchmark.cpp, so that benchmark measures the same code the sample runs
+
+#pragma once
+
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <utility>
+
+// define QUIET_SAMPLES before including to leave out the tracing output, e.g. when benchmarking
+#ifdef QUIET_SAMPLES
+#define MOVE_TRACE(out)
+#else
+#define MOVE_TRACE(out) std::cout << out << std::endl
+#endif
+
+#define LENGTH 10
+
+// comment out following if want to see the difference in output when no move constructors / move assignment operators are defined
+#define WITH_MOVE
+
+
+class Dummy
+{
+public:
+    Dummy()
+    {
+        MOVE_TRACE("In Dummy(). this = " << (void*)this);
+    }
+
+    Dummy(const Dummy& other)
+    {
+        MOVE_TRACE("In Dummy(const Dummy&). this = " << (void*)this);
+    }
+
+#ifdef WITH_MOVE
+    Dummy(const Dummy&& other)
+    {
+        MOVE_TRACE("In Dummy(const Dummy&&). this = " << (void*)this);
+    }
+#endif
+
+    Dummy& operator=(const Dummy& other)
+    {
+        MOVE_TRACE("In Dummy::operator=(const Dummy& other). this = " << (void*)this);
+
+        return *this;
+    }
+
+#ifdef WITH_MOVE
+    Dummy& operator=(const Dummy&& other)
+    {
+        MOVE_TRACE("In Dummy::operator=(const Dummy&& other). this = " << (void*)this);
+
+        return *this;
+    }
+#endif
+
+    ~Dummy()
+    {
+        MOVE_TRACE("In ~Dummy(). this = " << (void*)this);
+    }
+};
+
+
+class MemoryMoveBlock
+{
+public:
+    explicit MemoryMoveBlock()
+        : _data(new int[LENGTH])
+        , _dummy("Test")
+    {
+        MOVE_TRACE("Created resource " << (void*)_data);
+        MOVE_TRACE("In MemoryMoveBlock(). this = " << (void*)this << " data = " << (void*)_data << ".");
+    }
+
+    ~MemoryMoveBlock()
+    {
+        MOVE_TRACE("In ~MemoryMoveBlock(). this = " << (void*)this << " data = " << (void*)_data << ".");
+
+        if (_data != nullptr)
+        {
+            MOVE_TRACE("Deleting  resource " << (void*)_data);
+            delete[] _data;
+        }
+    }
+
+    MemoryMoveBlock(const MemoryMoveBlock& other)
+        : _data(new int[LENGTH])
+        , _dummy(other._dummy)
+    {
+        MOVE_TRACE("Created resource " << (void*)_data);
+        MOVE_TRACE("In MemoryMoveBlock(const MemoryMoveBlock&). this = " << (void*)this << " data = " << (void*)_data << ". Copying resource.");
+
+        std::copy(other._data, other._data + LENGTH, _data);
+    }
+
+#ifdef WITH_MOVE
+    MemoryMoveBlock(MemoryMoveBlock&& other)
+        : _data(std::exchange(other._data, nullptr))              // explicit move of a member of non class type (note that std::exchange is c++14)
+        , _dummy(std::move(other._dummy))              // explicit move of a member of class type
+    {
+        MOVE_TRACE("In MemoryBlock(MemoryBlock&&). this = " << (void*)this << " data = " << (void*)_data << ". Moved resource.");
+        MOVE_TRACE("After MemoryBlock(MemoryBlock&&). other = " << (void*)&other << " data = " << (void*)other._data);
+    }
+
+    MemoryMoveBlock& operator=(MemoryMoveBlock&& other)
+    {
+        MOVE_TRACE("In operator=(MemoryMoveBlock&&). this = " << (void*)this << " data = " << (void*)_data << ". Moving resource.");
+        MOVE_TRACE("In operator=(MemoryMoveBlock&&). other = " << (void*)&other << " data = " << (void*)other._data);
+
+        if (this != &other) {
+            MOVE_TRACE("Deleting  resource " << (void*)_data);
+            delete[] _data;
+
+            _data = std::exchange(other._data, nullptr);
+            _dummy = std::move(other._dummy);
+        }
+
+        MOVE_TRACE("After operator=(MemoryMoveBlock&&). this = " << (void*)this << " data = " << (void*)_data);
+        MOVE_TRACE("After operator=(MemoryMoveBlock&&). other = " << (void*)&other << " data = " << (void*)other._data);
+        return *this;
+    }
+#endif
+
+    MemoryMoveBlock& operator=(const MemoryMoveBlock& other)
+    {
+        MOVE_TRACE("In operator=(const MemoryMoveBlock&). this = " << (void*)this << " data = " << (void*)_data << ". Copying resource.");
+
+        if (this != &other)
+        {
+            MOVE_TRACE("Deleting  resource " << (void*)_data);
+            delete[] _data;
+
+            _data = new int[LENGTH];
+            _dummy = other._dummy;
+            MOVE_TRACE("Created resource " << (void*)_data);
+            std::copy(other._data, other._data + LENGTH, _data);
+        }
+        return *this;
+    }
+
+    const std::string& getDummy() { return _dummy; }
+
+private:
+    int* _data; // The non class resource.
+    std::string _dummy; // The class resource
+};
@@ -7,6 +7,12 @@
 #include <sstream>
 #include <condition_variable>
 #include <vector>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <chrono>
+
+#include "Philosophers.h"
 
 #ifdef __cpp_lib_syncbuf
 #include <syncstream>
@@ -157,6 +163,66 @@ private:
 	static std::condition_variable start;
 };
 
+// each diner repeatedly takes k random forks from shared pool, randomly chosen forks can repeat so diner may end up with less than k
+void benchmarkMultiLock(unsigned k, unsigned numThreads, unsigned spinCount, std::vector<QuietFork>& pool, unsigned transactions)
+{
+	std::atomic<unsigned long> acquired{ 0 }, failedTries{ 0 }, contended{ 0 }, blocked{ 0 };
+	for (auto& fork : pool)
+		fork.uses = 0;
+
+	auto diner = [&](unsigned seed) {
+		std::mt19937 mersenne_engine{ seed };
+		std::uniform_int_distribution<std::size_t> dist(0, pool.size() - 1);
+		unsigned long myAcquired = 0, myFailedTries = 0, myContended = 0, myBlocked = 0;
+		std::vector<QuietFork*> forks(k);
+		for (unsigned t = 0; t < transactions / numThreads; t++) {
+			for (auto& f : forks)
+				f = &pool[dist(mersenne_engine)];
+			MultiLock<QuietFork> lock(forks.data(), forks.size(), spinCount);
+			for (auto& f : forks)
+				f->uses++;
+			myAcquired += lock.size();
+			myFailedTries += lock.getFailedTries();
+			myContended += lock.getContended();
+			myBlocked += lock.getBlocked();
+		}
+		acquired += myAcquired;
+		failedTries += myFailedTries;
+		contended += myContended;
+		blocked += myBlocked;
+	};
+
+	auto t0 = std::chrono::high_resolution_clock::now();
+	{
+#ifdef __cpp_lib_jthread
+		std::vector<std::jthread> threads;
+#else
+		std::vector<std::thread> threads;
+#endif
+		for (unsigned i = 0; i < numThreads; i++)
+			threads.emplace_back(diner, i + 1);
+#ifndef __cpp_lib_jthread
+		for (auto& th : threads)
+			th.join();
+#endif
+	}
+	auto t1 = std::chrono::high_resolution_clock::now();
+
+	// every diner increments each of its forks (duplicates too) while holding them, so lost updates would show up as mismatch
+	unsigned long uses = 0;
+	for (auto& fork : pool)
+		uses += fork.uses;
+	const unsigned long expectedUses = static_cast<unsigned long>(transactions / numThreads) * numThreads * k;
+
+	const double seconds = std::chrono::duration<double>(t1 - t0).count();
+	std::cout << "k " << k << ", threads " << numThreads << ", spin " << spinCount
+		<< ": " << (transactions / numThreads) * numThreads / seconds << " transactions/sec"
+		<< ", contended " << 100.0 * contended / acquired << "% of locks"
+		<< ", failed tries " << static_cast<double>(failedTries) / acquired << " per lock"
+		<< ", blocked " << 100.0 * blocked / acquired << "% of locks"
+		<< (uses == expectedUses ? "" : ", USES MISMATCH") << std::endl;
+}
+
 template<class User> std::atomic<unsigned> Fork<User>::cnt;
 std::atomic<unsigned> Philosopher::cnt;
 
@@ -166,8 +232,19 @@ std::mutex Philosopher::staticMtx;
 std::condition_variable Philosopher::start;
 
 
-int main()
+int main(int argc, char* argv[])
 {
+	if (argc > 1 && std::string(argv[1]) == "benchmark") {
+		const unsigned POOL_SIZE = 64;
+		const unsigned TRANSACTIONS = 100000;
+		std::vector<QuietFork> pool(POOL_SIZE);
+		for (unsigned k : { 2, 5, 10, 20, 50 })
+			for (unsigned numThreads : { 1, 2, 4, 8 })
+				for (unsigned spinCount : { 0, 64 })
+					benchmarkMultiLock(k, numThreads, spinCount, pool, TRANSACTIONS);
+		return 0;
+	}
+
 	const unsigned NUM_PHILOSOPHERS = 10;
 	const unsigned NUM_BITES = 10;
 	const unsigned BITE_DURATION = 1;
@@ -0,0 +1,121 @@
+// lock acquisition engine shared by Philosophers.cpp and Benchmark.cpp, so that benchmark measures the same code the sample runs
+
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <array>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+
+// tells the CPU we are busy waiting so it does not speculate ahead and hammer the cache line of the lock
+inline void cpuRelax()
+{
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	_mm_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield");
+#else
+	std::this_thread::yield();
+#endif
+}
+
+// acquires runtime sized array of Fork like locks (lock, try_lock, unlock and getId), unlike scoped_lock number of locks does not need to be known at compile time
+// locks are always taken in the same canonical order (ascending getId) so two MultiLocks can never deadlock, hence no back off and retry is needed
+// same lock passed more than once is taken only once, locks are released in reverse order when MultiLock goes out of scope
+template <class Lock>
+class MultiLock {
+public:
+	MultiLock(Lock* const* locks_, std::size_t count_, unsigned spinCount = 0) : count(count_)
+	{
+		// sets up to INLINE_LOCKS locks are sorted in place, so taking them does not allocate
+		if (count > INLINE_LOCKS) {
+			heapLocks.resize(count);
+			locks = heapLocks.data();
+		}
+		else {
+			locks = inlineLocks.data();
+		}
+		std::copy(locks_, locks_ + count, locks);
+		std::sort(locks, locks + count, [](const Lock* l1, const Lock* l2) { return l1->getId() < l2->getId(); });
+		count = std::unique(locks, locks + count, [](const Lock* l1, const Lock* l2) { return l1->getId() == l2->getId(); }) - locks;
+
+		// if lock throws, destructor will not run, so locks taken so far are released here
+		std::size_t acquired = 0;
+		try {
+			for (; acquired < count; acquired++) {
+				Lock* l = locks[acquired];
+				// first try_lock and then up to spinCount more, spinning is cheaper than sleeping in lock when lock is held only briefly
+				bool taken = l->try_lock();
+				failedTries += !taken;
+				contended += !taken;
+				for (unsigned spin = 0; spin < spinCount && !taken; spin++) {
+					cpuRelax();
+					taken = l->try_lock();
+					failedTries += !taken;
+				}
+				if (!taken) {
+					l->lock();
+					blocked++;
+				}
+			}
+		}
+		catch (...) {
+			release(acquired);
+			throw;
+		}
+	}
+
+	~MultiLock()
+	{
+		release(count);
+	}
+
+	MultiLock(const MultiLock&) = delete;
+	MultiLock& operator=(const MultiLock&) = delete;
+
+	std::size_t size() const { return count; }
+	unsigned getFailedTries() const { return failedTries; }
+	unsigned getContended() const { return contended; } // locks which were not taken on first try
+	unsigned getBlocked() const { return blocked; }
+
+private:
+	static constexpr std::size_t INLINE_LOCKS = 64;
+
+	void release(std::size_t acquired)
+	{
+		while (acquired > 0)
+			locks[--acquired]->unlock();
+	}
+
+	std::array<Lock*, INLINE_LOCKS> inlineLocks;
+	std::vector<Lock*> heapLocks;
+	Lock** locks;
+	std::size_t count;
+	unsigned failedTries = 0;
+	unsigned contended = 0;
+	unsigned blocked = 0;
+};
+
+// Fork without printing, used for benchmark where output would dominate the time
+class QuietFork : public std::mutex {
+public:
+	QuietFork() : forkId(++cnt) {};
+
+	unsigned getId() const
+	{
+		return forkId;
+	}
+
+	unsigned long uses = 0; // protected by the fork itself
+
+private:
+	unsigned forkId;
+
+	inline static std::atomic<unsigned> cnt;
+};
@@ -3,9 +3,7 @@
 #include <iostream>
 #include <algorithm>
 
-#ifndef __PRETTY_FUNCTION__
-	#define __PRETTY_FUNCTION__ __FUNCSIG__
-#endif
+#include "Variadic.h"
 
 // recursion stopper
 void print() {}
@@ -58,51 +56,6 @@ template<typename... Args> inline void expandStruct4(Args&&... args)
 }
 
 
-// recursion for tuple definition
-template <class... Ts> struct tuple {};
-
-template <class T, class... Ts>
-struct tuple<T, Ts...> : tuple<Ts...> {
-	tuple(T t, Ts... ts) : tuple<Ts...>(ts...), tail(t) {
-		std::cout << __PRETTY_FUNCTION__ << std::endl;
-	}
-
-	T tail;
-};
-
-
-// recursion for tuple type definition
-template <size_t, class> struct elem_type_holder;
-
-template <class T, class... Ts>
-struct elem_type_holder<0, tuple<T, Ts...>> {
-	typedef T type;
-};
-
-template <size_t k, class T, class... Ts>
-struct elem_type_holder<k, tuple<T, Ts...>> {
-	typedef typename elem_type_holder<k - 1, tuple<Ts...>>::type type;
-};
-
-
-// recursion for tuple get definition
-template <size_t k, class... Ts>
-typename std::enable_if<
-	k == 0, typename elem_type_holder<0, tuple<Ts...>>::type&>::type
-	get(tuple<Ts...>& t) {
-	std::cout << __PRETTY_FUNCTION__ << std::endl;
-	return t.tail;
-}
-
-template <size_t k, class T, class... Ts>
-typename std::enable_if<
-	k != 0, typename elem_type_holder<k, tuple<T, Ts...>>::type&>::type
-	get(tuple<T, Ts...>& t) {
-	std::cout << __PRETTY_FUNCTION__ << std::endl;
-	tuple<Ts...>& base = t;
-	return get<k - 1>(base);
-}
-
 int main()
 {
 	print(1, 2.1f, 3.2, 4l, "555");
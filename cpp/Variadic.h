@@ -0,0 +1,64 @@
+// recursive tuple of the variadic sample, shared by Variadic.cpp and Benchmark.cpp, so that benchmark measures the same code the sample runs
+
+#pragma once
+
+#include <iostream>
+#include <cstddef>
+#include <type_traits>
+
+// MSVC has no __PRETTY_FUNCTION__ but has equivalent __FUNCSIG__
+#ifdef _MSC_VER
+	#define __PRETTY_FUNCTION__ __FUNCSIG__
+#endif
+
+// define QUIET_SAMPLES before including to leave out the tracing output, e.g. when benchmarking
+#ifdef QUIET_SAMPLES
+#define VARIADIC_TRACE(out)
+#else
+#define VARIADIC_TRACE(out) std::cout << out << std::endl
+#endif
+
+// recursion for tuple definition
+template <class... Ts> struct tuple {};
+
+template <class T, class... Ts>
+struct tuple<T, Ts...> : tuple<Ts...> {
+	tuple(T t, Ts... ts) : tuple<Ts...>(ts...), tail(t) {
+		VARIADIC_TRACE(__PRETTY_FUNCTION__);
+	}
+
+	T tail;
+};
+
+
+// recursion for tuple type definition
+template <size_t, class> struct elem_type_holder;
+
+template <class T, class... Ts>
+struct elem_type_holder<0, tuple<T, Ts...>> {
+	typedef T type;
+};
+
+template <size_t k, class T, class... Ts>
+struct elem_type_holder<k, tuple<T, Ts...>> {
+	typedef typename elem_type_holder<k - 1, tuple<Ts...>>::type type;
+};
+
+
+// recursion for tuple get definition
+template <size_t k, class... Ts>
+typename std::enable_if<
+	k == 0, typename elem_type_holder<0, tuple<Ts...>>::type&>::type
+	get(tuple<Ts...>& t) {
+	VARIADIC_TRACE(__PRETTY_FUNCTION__);
+	return t.tail;
+}
+
+template <size_t k, class T, class... Ts>
+typename std::enable_if<
+	k != 0, typename elem_type_holder<k, tuple<T, Ts...>>::type&>::type
+	get(tuple<T, Ts...>& t) {
+	VARIADIC_TRACE(__PRETTY_FUNCTION__);
+	tuple<Ts...>& base = t;
+	return get<k - 1>(base);
+}